@@ -0,0 +1,124 @@
+#! /bin/sh
+# bench.sh
+# Copyright (c) 2019 Marc Espie <espie@openbsd.org>
+#
+# Permission to use, copy, modify, and distribute this software for any
+# purpose with or without fee is hereby granted, provided that the above
+# copyright notice and this permission notice appear in all copies.
+#
+# THE SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+# WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+# ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+# WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS, WHETHER IN AN
+# ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+# OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+
+# time each stage of rr separately, through rr -T, on synthetic trees
+# and lists.  Data is generated once under BENCH_DIR and reused.
+# One line per stage, with the best of BENCH_RUNS runs.
+#
+# usage: bench.sh [path/to/rr]
+
+set -e
+
+RR=${1:-./rr}
+FILES=${BENCH_FILES:-1000000}
+LINES=${BENCH_LINES:-3000000}
+RUNS=${BENCH_RUNS:-3}
+DIR=${BENCH_DIR:-${TMPDIR:-/tmp}/rr-bench}
+
+if ! test -x "$RR"; then
+	echo "$0: no $RR to run" >&2
+	exit 1
+fi
+
+# wide: 1000 directories, long names with spaces
+# deep: chains of 32 directories, a few files at each level
+make_trees()
+{
+	echo "generating $FILES files in $DIR (once)" >&2
+	rm -rf "$DIR/wide" "$DIR/deep"
+	awk -v n="$FILES" -v d="$DIR" 'BEGIN {
+		for (i = 0; i < n; i++)
+			printf "%s/wide/dir %03d/a long file name, with spaces %07d.dat\n", d, i % 1000, i
+	}' >"$DIR/wide.list"
+	awk -v n="$FILES" -v d="$DIR" 'BEGIN {
+		for (i = 0; i < n / 10; i++) {
+			p = d "/deep/" (i % 100)
+			for (j = 0; j < (i % 32); j++)
+				p = p "/l" j
+			for (k = 0; k < 10; k++)
+				printf "%s/f%07d_%d\n", p, i, k
+		}
+	}' >"$DIR/deep.list"
+	for t in wide deep; do
+		sed -e 's,/[^/]*$,,' "$DIR/$t.list" | sort -u |
+		    tr '\n' '\0' | xargs -0 mkdir -p
+		tr '\n' '\0' <"$DIR/$t.list" | xargs -0 touch
+	done
+	touch "$DIR/trees.$FILES"
+}
+
+make_lists()
+{
+	echo "generating $LINES lines in $DIR (once)" >&2
+	awk -v n="$LINES" 'BEGIN {
+		srand(1)
+		for (i = 0; i < n; i++)
+			printf "/home/media/collection %d/artist %d/album %d/%07d - track %d.%s\n", i % 7, i % 911, i % 5003, i, int(rand() * 100), (i % 3 ? "flac" : "mp3")
+	}' >"$DIR/big.list"
+	touch "$DIR/lists.$LINES"
+}
+
+mkdir -p "$DIR"
+test -f "$DIR/trees.$FILES" || make_trees
+test -f "$DIR/lists.$LINES" || make_lists
+
+# run rr -T RUNS times, keep the best wall time for phase,
+# and report cpu and peak rss for that run
+stage()
+{
+	name=$1
+	phase=$2
+	shift 2
+	i=0
+	while test $i -lt "$RUNS"; do
+		"$RR" -T "$@" 2>&1 >/dev/null | grep '^{"phases"'
+		i=$((i + 1))
+	done | awk -v name="$name" -v phase="$phase" '
+	function field(s, key,    r) {
+		if (!match(s, "\"" key "\":[-0-9.e]+"))
+			return "-"
+		r = substr(s, RSTART, RLENGTH)
+		sub(/.*:/, "", r)
+		return r
+	}
+	{
+		if (!match($0, "\"" phase "\":\\{[^}]*\\}"))
+			next
+		p = substr($0, RSTART, RLENGTH)
+		w = field(p, "wall")
+		if (best == "" || w + 0 < best + 0) {
+			best = w
+			cpu = field(p, "cpu")
+			rss = field($0, "peak_rss_kb")
+			kept = field($0, "kept")
+		}
+	}
+	END {
+		if (best == "")
+			best = cpu = rss = kept = "-"
+		printf "%-10s %-8s %10s %10s %10s %10s\n", name, phase, best, cpu, rss, kept
+	}'
+}
+
+printf "%-10s %-8s %10s %10s %10s %10s\n" stage phase wall cpu rss_kb entries
+stage scan-r scan -p -r -- "$DIR/wide"
+stage scan-D scan -p -D -- "$DIR/deep"
+stage read read -p -N -l "$DIR/big.list"
+stage filter filter -p -N -x '.*\.mp3' -x '.*/artist 1[0-9]*/.*' \
+    -o '.*track [1-4][0-9]\..*' -o '.*collection [0-3]/.*' -l "$DIR/big.list"
+stage shuffle shuffle -p -l "$DIR/big.list"
+stage batch run -p -N -n 64 -w 8 -l "$DIR/big.list"
+stage print run -p -n 2 -l "$DIR/big.list"